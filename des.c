@@ -1,12 +1,12 @@
 
 #include "des.h"
+#include <stdarg.h>
 
 /*
  * Global variables:
  */
 
-char PERMUTED_KEYS[16][48];
-short DEBUG = 0;
+static char PERMUTED_KEYS[16][48];
 
 //============================== STATIC TABLES ================================
 
@@ -184,15 +184,125 @@ static char IP_REVERSED[64] =
 };
 
 
+// ------------------------------ UTILITIES -----------------------------------
+
+/*
+ * Round by round trace of the reference engine, compiled in with -DDES_DEBUG.
+ * Otherwise the body is empty and the calls are optimised away.
+ */
+__attribute__((format(printf,1,2)))
+static void print_debug(const char *format, ...)
+{
+#ifdef DES_DEBUG
+  va_list args;
+  va_start(args,format);
+  printf("DEBUG ");
+  vprintf(format,args);
+  printf("\n");
+  va_end(args);
+#else
+  (void)format;
+#endif
+};
+
+static int binchars_to_unsigned(char * binchars, int length)
+{
+  int i;
+  int total = 0;
+  for(i=length-1;i>=0;i--)
+  {
+    if(binchars[i] == '1')
+    {
+      total += pow(2,(length - (i+1)));
+    }
+  }
+  return total;
+};
+
+static void unsigned_to_binchars(int unsigned_int, char * binchars, int length)
+{
+  int i;
+  for(i=0;i<length;i++)
+  {
+    binchars[(length - (i+1))] = (unsigned_int & (int)pow(2,i)) ? '1' : '0';
+  }
+};
+
+/* 
+ * Function to convert binary to int.
+ */
+static int binary_to_int(int n) 
+{
+  int decimal=0, i=0, rem;
+  while (n!=0)
+  {
+    rem = n%10;
+    n/=10; 
+    decimal += rem*pow(2,i);
+    ++i;
+  }
+  return decimal;
+};
+
+/*
+ * This is evisioned to work with characters that are 1 byte only.
+ */
+static void char_to_binchars(char c,char *binchars)
+{
+  unsigned char mask = 1; // Bit mask
+  char bits[8];
+  int i;
+  for (i=0;i<8;i++) 
+  {
+    // Mask each bit in the byte and store it
+    bits[(8 - (i+1))] = (c & (mask << i)) != 0;
+  };
+  for (i=0;i<8;i++) 
+  {
+    binchars[i] = (char)(((int)'0')+bits[i]);
+  }
+};
+
+/*
+ * This is converts 8 bytes character chunk into binchars.
+ */
+static void chars8_to_binchars(char *chars8, char *binchars64)
+{
+  char char8[8];
+  int i;
+  for (i=0;i<8;i++)
+  {
+    char_to_binchars(chars8[i],char8); 
+    strncpy(binchars64+(i * 8),char8,8);
+  }
+};
+
+/*
+ * This is converts 64 binchars into 8 characters.
+ */
+static void binchars64_to_char8(char *binchars64, char *plain8)
+{
+  int i;
+  for(i=0;i<8;i++) {
+    // atol() needs a terminated string
+    char bits[9];
+    strncpy(bits,binchars64+(i*8),8);
+    bits[8] = '\0';
+    char c = (char) binary_to_int(atol(bits));
+    plain8[i] = c;
+  } 
+};
+
+
 // ------------------------ ROUND KEYS GENERATION -----------------------------
 
 
-void perform_key_permutation(char keys[16][56]) 
+static void perform_key_permutation(char keys[16][56]) 
 {
   int i;
   for(i=0;i<16;i++) 
   { 
-    char *permutedKey = malloc(sizeof(char[48]));
+    char permutedKey[48];
     int k;
     for (k=0;k<48;k++)
     {
@@ -201,9 +311,7 @@ void perform_key_permutation(char keys[16][56])
     }
     strncpy(PERMUTED_KEYS[i],permutedKey,48);
     //printf("%d PERMUTED KEY:  %.*s\n",i,48,PERMUTED_KEYS[i]);
-    char msg[124];
-    int l = sprintf (msg,"%d PERMUTED KEY:  %.*s",i,48,PERMUTED_KEYS[i]); 
-    print_debug(msg,l);
+    print_debug("%d PERMUTED KEY:  %.*s",i,48,PERMUTED_KEYS[i]);
   };
 };
 
@@ -212,7 +320,7 @@ void perform_key_permutation(char keys[16][56])
  * Note only 56 bits of the original key appear in the permuted key 
  * i.e. the table does not specify the position for the 8th, 16th, 32nd, 40th, 48th, 56th and 64th bit.  
  */
-void perform_first_permutation(char *left_des_key,char *right_des_key,char *bin_des_key) 
+static void perform_first_permutation(char *left_des_key,char *right_des_key,char *bin_des_key) 
 {
   char permuted_key[56];
   int i;
@@ -230,7 +338,7 @@ void perform_first_permutation(char *left_des_key,char *right_des_key,char *bin_
 /*
  * Populates the static array PERMUTED_KEYS with the 16 round keys. 
  */
-void generate_keys(char *des_key)
+static void generate_keys(char *des_key)
 {
   // turn des_key into binchars
   char binchar_des_key[64];
@@ -241,9 +349,7 @@ void generate_keys(char *des_key)
   perform_first_permutation(bin_left_des_key,bin_right_des_key,binchar_des_key);
   
   //printf("First key permutation:  %.*s  %.*s\n",28,bin_left_des_key,28,bin_right_des_key);
-  char debug_msg[124];
-  int l = sprintf(debug_msg,"First key permutation:  %.*s  %.*s",28,bin_left_des_key,28,bin_right_des_key); 
-  print_debug(debug_msg,l);
+  print_debug("First key permutation:  %.*s  %.*s",28,bin_left_des_key,28,bin_right_des_key);
 
   char shifted_keys[16][56];
   int i;
@@ -267,9 +373,7 @@ void generate_keys(char *des_key)
       strncpy(shiftedKey+28,shifted_keys[i-1]+28+shift,28-shift);
       strncpy(shifted_keys[i]+28,shiftedKey+28,28);
     }
-    char debug_msg[124];
-    int l = sprintf(debug_msg,"%d SHIFTED KEY: %.*s",i,56,shifted_keys[i]); 
-    print_debug(debug_msg,l);
+    print_debug("%d SHIFTED KEY: %.*s",i,56,shifted_keys[i]);
     //printf("%d SHIFTED KEY: %.*s\n",i,56,shifted_keys[i]);
   }
   perform_key_permutation(shifted_keys);
@@ -282,7 +386,7 @@ void generate_keys(char *des_key)
 /*
  * Performs initial permutation using IP table.
  */
-void perform_ip(char *binchars,char *ip_bin_msg) 
+static void perform_ip(char *binchars,char *ip_bin_msg) 
 {
   char permuted_msg[64];
   int i;
@@ -298,7 +402,7 @@ void perform_ip(char *binchars,char *ip_bin_msg)
 /*
  * Expands data chunk from 32 to 48bits using E table.
  */
-void expand_data_to_48bits(char *last_right, char *buf, int length)
+static void expand_data_to_48bits(char *last_right, char *buf, int length)
 {
   int i;
   for(i=0;i<length;i++) 
@@ -312,7 +416,7 @@ void expand_data_to_48bits(char *last_right, char *buf, int length)
  * Get a character representation of a bit XOR.
  */
 
-char char_xor(char c1, char c2) 
+static char char_xor(char c1, char c2) 
 {
   return c1 == c2 ? '0' : '1';
 }
@@ -322,7 +426,7 @@ char char_xor(char c1, char c2)
  * the S tables to generate a 32bit chunk and permutes with the table P to
  * generate the final output. 
  */
-void f(char *fOutput, char *last_right, int round)
+static void f(char *fOutput, char *last_right, int round)
 {
   char expaded_data_chunk[48];
   expand_data_to_48bits(last_right,expaded_data_chunk,48);
@@ -334,9 +438,7 @@ void f(char *fOutput, char *last_right, int round)
     xored[i] = char_xor(expaded_data_chunk[i],PERMUTED_KEYS[round][i]);
   }
 
-  char debug_msg[124];
-  int l = sprintf(debug_msg,"XORED DATA: %.*s",48,xored); 
-  print_debug(debug_msg,l);
+  print_debug("XORED DATA: %.*s",48,xored);
   //printf("XORED DATA: %.*s\n",48,xored);
 
   char sBoxed[32];
@@ -354,13 +456,10 @@ void f(char *fOutput, char *last_right, int round)
     unsigned_to_binchars(sValInt,sValBinChar,4);
     strncpy(sBoxed+(i*4),sValBinChar,4);
     
-    char debug_msg[124];
-    l = sprintf(debug_msg,"SBOX LOOKUP FOR CHUNK %d (%.*s) is row %d col %d -> %d(int) = %.*s(bin)",i+1,6,sixBitChunk,row,cols,sValInt,4,sValBinChar); 
-    print_debug(debug_msg,l);
+    print_debug("SBOX LOOKUP FOR CHUNK %d (%.*s) is row %d col %d -> %d(int) = %.*s(bin)",i+1,6,sixBitChunk,row,cols,sValInt,4,sValBinChar);
     //printf("SBOX LOOKUP FOR CHUNK %d (%.*s) is row %d col %d -> %d(int) = %.*s(bin)\n",i+1,6,sixBitChunk,row,cols,sValInt,4,sValBinChar);
   }
-  l = sprintf(debug_msg,"SBOXed KEY IS %.*s",32,sBoxed); 
-  print_debug(debug_msg,l);
+  print_debug("SBOXed KEY IS %.*s",32,sBoxed);
   //printf("SBOXed KEY IS %.*s\n",32,sBoxed);
 
   // permute SBOXed key using P table
@@ -389,15 +488,13 @@ void f(char *fOutput, char *last_right, int round)
  *    the previous step with the calculation f 
  */
 
-void crypt(char *msg, char *plain)
+static void crypt(char *msg, char *plain)
 { 
   // turn msg into binchars
   char binchar_msg[64];
   chars8_to_binchars(msg,binchar_msg); 
 
-  char debug_msg[124];
-  int lgth = sprintf(debug_msg,"MSG: %.*s BINCHARS: %.*s",8,msg,64,binchar_msg); 
-  print_debug(debug_msg,lgth);
+  print_debug("MSG: %.*s BINCHARS: %.*s",8,msg,64,binchar_msg);
   //printf("MSG: %.*s BINCHARS: %.*s\n",8,msg,64,binchar_msg);
 
 
@@ -415,24 +512,20 @@ void crypt(char *msg, char *plain)
       // this performs initial permutation 
       perform_ip(binchar_msg,ip_binchars);
      
-      char debug_msg[124];
-      int l = sprintf(debug_msg,"Initial data permutation: %.*s",64,ip_binchars); 
-      print_debug(debug_msg,l);
+      print_debug("Initial data permutation: %.*s",64,ip_binchars);
       //printf("Initial data permutation: %.*s\n",64,ip_binchars);
 
       char l0[32];
       strncpy(l0,ip_binchars,32);
 
-      l = sprintf(debug_msg,"L0 %.*s",32,l0); 
-      print_debug(debug_msg,l);
+      print_debug("L0 %.*s",32,l0);
       //printf("L0 %.*s\n",32,l0);
 
       char r0[32];
       strncpy(r0,ip_binchars+32,32);
 
       //printf("R0 %.*s\n",32,r0);
-      l = sprintf(debug_msg,"R0 %.*s",32,r0); 
-      print_debug(debug_msg,l);
+      print_debug("R0 %.*s",32,r0);
 
       // left chunk of data of the first iteration is the right chunk of data affter initial permutation 
       char l1[32];
@@ -442,8 +535,7 @@ void crypt(char *msg, char *plain)
       f(fResult,r0,i);
 
       //printf("F() result is %.*s\n",32,fResult);
-      l = sprintf(debug_msg,"F() result is %.*s",32,fResult); 
-      print_debug(debug_msg,l);
+      print_debug("F() result is %.*s",32,fResult);
 
       char r1[32];
       int z;
@@ -452,19 +544,16 @@ void crypt(char *msg, char *plain)
         r1[z] = char_xor(l0[z],fResult[z]);
       }
 
-      l = sprintf(debug_msg,"L%d: %.*s",i+1,32,l1); 
-      print_debug(debug_msg,l);
+      print_debug("L%d: %.*s",i+1,32,l1);
       //printf("L%d: %.*s\n",i+1,32,l1);
 
       strncpy(left,l1,32);
 
-      l = sprintf(debug_msg,"R%d: %.*s",i+1,32,r1); 
-      print_debug(debug_msg,l);
+      print_debug("R%d: %.*s",i+1,32,r1);
       //printf("R%d: %.*s\n",i+1,32,r1);
 
       strncpy(right,r1,32);
     } else {
-      char debug_msg[124];
       // Li = Ri-1
       char l[32];
       strncpy(l,right,32);
@@ -472,8 +561,7 @@ void crypt(char *msg, char *plain)
       char fResult[32];
       f(fResult,right,i);
 
-      int lgth = sprintf(debug_msg,"F() result is %.*s",32,fResult); 
-      print_debug(debug_msg,lgth);
+      print_debug("F() result is %.*s",32,fResult);
       //printf("F() result is %.*s\n",32,fResult);
 
       char r[32];
@@ -483,14 +571,12 @@ void crypt(char *msg, char *plain)
         r[z] = char_xor(left[z],fResult[z]);
       }
 
-      lgth = sprintf(debug_msg,"L%d: %.*s",i+1,32,l); 
-      print_debug(debug_msg,lgth);
+      print_debug("L%d: %.*s",i+1,32,l);
       //printf("L%d: %.*s\n",i+1,32,l);
 
       strncpy(left,l,32);
 
-      lgth = sprintf(debug_msg,"R%d: %.*s",i+1,32,r); 
-      print_debug(debug_msg,lgth);
+      print_debug("R%d: %.*s",i+1,32,r);
       //printf("R%d: %.*s\n",i+1,32,r);
 
       strncpy(right,r,32);
@@ -510,7 +596,6 @@ void crypt(char *msg, char *plain)
     int permutedPosition = IP_REVERSED[i];
     final_chunk[i] = concatenated_chunk[permutedPosition-1];
   };
-  printf("\r"); // needed to ensure the same results in cygwin and rhel envs
   binchars64_to_char8(final_chunk,plain);
 };
 
@@ -518,7 +603,7 @@ void crypt(char *msg, char *plain)
 // ----------------------------------------------------------------------------
 
 /* Function to reverse arr[] from start to end*/
-void reverse_keys()
+static void reverse_keys()
 {
   int start = 0;
   int end = 15;
@@ -539,38 +624,3 @@ void crypt_chunk(char *text_8chars, char *key_8chars, char enorde, char *result)
   if (enorde == 'd') {reverse_keys();};
   crypt(text_8chars,result);
 }
-
-/*
- * ============================================================================
- * ============================================================================
- * ============================================================================
- */
-int main(void) 
-{
-  DEBUG = 0;
-  /*
-   * DES operates on the 64-bit blocks using key sizes of 56- bits. 
-   * The keys are actually stored as being 64 bits long, but every 8th bit in the key is not used 
-   * (i.e. bits numbered 8, 16, 24, 32, 40, 48, 56, and 64). 
-   */
-
-  char key[8] = "S0mEKee!";
-  printf("64(56) bit key: %.*s\n",8,key);
-
-  char msg[8] = "8byteMSG";
-  printf("Plain msg:      %.*s\n",8,msg);
-  
-  char result[8];
-  crypt_chunk(msg,key,'e',result);
-
-  printf("Ciphered msg:   %.*s\n",8,result); 
-
-  char decrypted[8];
-  crypt_chunk(result,key,'d',decrypted);
-
-  printf("Decrypted msg:  %.*s\n",8,decrypted);
- 
-  //file_cipher();
-  return 0;
-};
-
@@ -3,35 +3,69 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include "libdes.h"
+
+// ================================== PACKED KEY TABLES =======================
+
+#ifndef PACKED_KEY_TABLES_INCLUDED
+#define PACKED_KEY_TABLES_INCLUDED
+
+/*
+ * PC-1 and PC-2 as in des.c, stored as bytes. Shared by the compact and
+ * batch key schedules; static so they stay out of the library's symbols.
+ */
+static const uint8_t PC_1_PACKED[56] =
+{
+  57,  49,  41,  33,  25,  17,   9,
+   1,  58,  50,  42,  34,  26,  18,
+  10,   2,  59,  51,  43,  35,  27,
+  19,  11,   3,  60,  52,  44,  36,
+  63,  55,  47,  39,  31,  23,  15,
+   7,  62,  54,  46,  38,  30,  22,
+  14,   6,  61,  53,  45,  37,  29,
+  21,  13,   5,  28,  20,  12,   4
+};
+
+static const uint8_t PC_2_PACKED[48] =
+{
+  14,  17,  11,  24,   1,   5,
+   3,  28,  15,   6,  21,  10,
+  23,  19,  12,   4,  26,   8,
+  16,   7,  27,  20,  13,   2,
+  41,  52,  31,  37,  47,  55,
+  30,  40,  51,  45,  33,  48,
+  44,  49,  39,  56,  34,  53,
+  46,  42,  50,  36,  29,  32
+};
+
+/*
+ * The left shift schedule as a bitmask: bit n set means round n rotates
+ * the key halves by two places, otherwise by one.
+ */
+static const uint16_t DOUBLE_SHIFTS = 0x7EFC;
 
-#ifndef GLOBALS_INCLUDED
-#define GLOBALS_INCLUDED
-extern char PERMUTED_KEYS[16][48];
-extern short DEBUG;
 #endif
 
-// ================================== FUNCTIONS ===============================
+// ================================== COMPACT INTERNALS =======================
 
-#ifndef FUNCTIONS_UTILS_INCLUDED
-#define FUNCTIONS_UTILS_INCLUDED
+#ifndef COMPACT_INTERNALS_INCLUDED
+#define COMPACT_INTERNALS_INCLUDED
 
-void print_debug(char *debug_msg,int length);
-int binchars_to_unsigned(char * binchars, int length);
-void unsigned_to_binchars(int unsigned_int, char * binchars, int length);
-int int_to_binary(int n);
-int binary_to_int(int n);
-void char_to_binchars(char c,char *binchars);
-void chars8_to_binchars(char *chars8, char *binchars64);
-void binchars64_to_char8(char *binchars64, char *plain8);
-void print_permuted_keys();
+/*
+ * Engine hooks for des_stats.c and des_verify, hidden like the rest of the
+ * library: rounds[n] is LnRn after round n+1, and compact_sbox_lookup()
+ * is S[box] applied to a 6 bit chunk.
+ */
+uint64_t compact_crypt_rounds(uint64_t block, const uint64_t subkeys[16], uint64_t rounds[16]);
+uint32_t compact_sbox_lookup(int box, uint32_t chunk);
 
 #endif
 
+// ================================== FUNCTIONS ===============================
+
 #ifndef FUNCTIONS_FILE_INCLUDED
 #define FUNCTIONS_FILE_INCLUDED
 
 void file_cipher();
 
 #endif
-
-
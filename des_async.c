@@ -0,0 +1,69 @@
+#include "des.h"
+
+/*
+ * Resumable bulk encryption. A job holds everything needed to carry on from
+ * where the previous step stopped, so an event loop can call des_job_step()
+ * between servicing other connections instead of blocking on one large
+ * buffer.
+ */
+
+void des_job_init(struct des_job *job, const char *in, char *out, size_t length,
+  const char *key_8chars, char enorde, short constant_time, size_t blocks_per_step,
+  void (*on_complete)(struct des_job *job, void *user_data), void *user_data)
+{
+  memset(job,0,sizeof(*job));
+  job->in = in;
+  job->out = out;
+  job->length = length - length % 8;
+  job->enorde = enorde;
+  job->constant_time = constant_time;
+  // keep blocks_per_step * 8 from wrapping in des_job_step()
+  if (blocks_per_step < 1) {blocks_per_step = 1;};
+  if (blocks_per_step > SIZE_MAX / 8) {blocks_per_step = SIZE_MAX / 8;};
+  job->blocks_per_step = blocks_per_step;
+  job->on_complete = on_complete;
+  job->user_data = user_data;
+  job->state = DES_JOB_PENDING;
+  compact_generate_keys(key_8chars,job->subkeys);
+}
+
+/*
+ * Processes at most blocks_per_step blocks. When the last block is done the
+ * completion callback runs once, from inside this call, and DES_JOB_DONE is
+ * returned from then on. The callback may free the job: nothing touches it
+ * once the callback has been called.
+ */
+int des_job_step(struct des_job *job)
+{
+  if (job->state == DES_JOB_DONE) {return DES_JOB_DONE;};
+
+  size_t remaining = job->length - job->offset;
+  size_t step = job->blocks_per_step * 8;
+  if (step > remaining) {step = remaining;};
+  job->offset += compact_crypt_buffer(job->in + job->offset,job->out + job->offset,step,
+    job->subkeys,job->enorde,job->constant_time);
+
+  if(job->offset == job->length)
+  {
+    job->state = DES_JOB_DONE;
+    if (job->on_complete) {job->on_complete(job,job->user_data);};
+    return DES_JOB_DONE;
+  }
+  return DES_JOB_PENDING;
+}
+
+/*
+ * Drives a job to completion on the calling thread, returns the number of
+ * steps that ran (0 if the job was already done). As with des_job_step()
+ * the job must not be used afterwards if the callback frees it.
+ */
+size_t des_job_run(struct des_job *job)
+{
+  if (job->state == DES_JOB_DONE) {return 0;};
+  size_t steps = 1;
+  while(des_job_step(job) == DES_JOB_PENDING)
+  {
+    steps++;
+  }
+  return steps;
+}
@@ -0,0 +1,149 @@
+#include "des.h"
+#include <time.h>
+
+/*
+ * Benchmark suite, also the training run for the PGO build.
+ * Usage: des_bench [scale], where scale multiplies the amount of work.
+ */
+
+static double now_seconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, double seconds, double units, const char *unit)
+{
+  printf("%-24s %10.0f %s/s  (%.3f s)\n",name,units / seconds,unit,seconds);
+}
+
+static void bench_reference(long scale)
+{
+  char key[8] = "S0mEKee!";
+  char block[8] = "8byteMSG";
+  long n, count = 2000 * scale;
+  double start = now_seconds();
+  for(n=0;n<count;n++)
+  {
+    crypt_chunk(block,key,'e',block);
+  }
+  report("reference crypt_chunk",now_seconds() - start,count,"blocks");
+}
+
+static void bench_key_schedule(long scale)
+{
+  char key[8] = "S0mEKee!";
+  uint64_t subkeys[16];
+  long n, count = 100000 * scale;
+  double start = now_seconds();
+  for(n=0;n<count;n++)
+  {
+    key[n & 7] ^= (char)n;
+    compact_generate_keys(key,subkeys);
+  }
+  report("compact key schedule",now_seconds() - start,count,"keys");
+}
+
+static void bench_key_schedule_batch(long scale)
+{
+  size_t count = 10000;
+  char *keys = malloc(count * 8);
+  uint64_t *schedules = malloc(count * 16 * sizeof(uint64_t));
+  if(!keys || !schedules)
+  {
+    perror("Allocating bench keys failed");
+    free(keys);
+    free(schedules);
+    return;
+  }
+  size_t i;
+  for(i=0;i<count*8;i++)
+  {
+    keys[i] = (char)(i * 131);
+  }
+  long n, passes = 10 * scale;
+  double start = now_seconds();
+  for(n=0;n<passes;n++)
+  {
+    keys[n & 7] ^= (char)n;
+    compact_generate_keys_batch(keys,count,schedules);
+  }
+  report("batch key schedule",now_seconds() - start,(double)passes * count,"keys");
+  free(keys);
+  free(schedules);
+}
+
+static void bench_buffer(long scale, short constant_time)
+{
+  size_t length = 1 << 20;
+  char *buffer = malloc(length);
+  if(!buffer)
+  {
+    perror("Allocating bench buffer failed");
+    return;
+  }
+  memset(buffer,'x',length);
+  uint64_t subkeys[16];
+  compact_generate_keys("S0mEKee!",subkeys);
+  long n, passes = constant_time ? scale : 4 * scale;
+  double start = now_seconds();
+  for(n=0;n<passes;n++)
+  {
+    compact_crypt_buffer(buffer,buffer,length,subkeys,n & 1 ? 'd' : 'e',constant_time);
+  }
+  report(constant_time ? "compact buffer (ct)" : "compact buffer",
+    now_seconds() - start,(double)passes * length / (1 << 20),"MB");
+  free(buffer);
+}
+
+static void bench_job(long scale)
+{
+  size_t length = 1 << 20;
+  char *buffer = malloc(length);
+  if(!buffer)
+  {
+    perror("Allocating bench buffer failed");
+    return;
+  }
+  memset(buffer,'x',length);
+  struct des_job job;
+  long n, passes = 4 * scale;
+  double start = now_seconds();
+  for(n=0;n<passes;n++)
+  {
+    des_job_init(&job,buffer,buffer,length,"S0mEKee!",'e',0,256,NULL,NULL);
+    des_job_run(&job);
+  }
+  report("async job (256/step)",now_seconds() - start,(double)passes * length / (1 << 20),"MB");
+  free(buffer);
+}
+
+static void bench_stats(long scale)
+{
+  struct des_stats *stats = malloc(sizeof(struct des_stats));
+  if(!stats)
+  {
+    perror("Allocating stats failed");
+    return;
+  }
+  uint64_t samples = 20000 * scale;
+  double start = now_seconds();
+  des_stats_collect(stats,samples,1,1);
+  report("avalanche stats",now_seconds() - start,samples,"samples");
+  free(stats);
+}
+
+int main(int argc, char **argv)
+{
+  long scale = argc > 1 ? strtol(argv[1],NULL,10) : 1;
+  if (scale < 1) {scale = 1;};
+  bench_reference(scale);
+  bench_key_schedule(scale);
+  bench_key_schedule_batch(scale);
+  bench_buffer(scale,0);
+  bench_buffer(scale,1);
+  bench_job(scale);
+  bench_stats(scale);
+  return 0;
+}
@@ -0,0 +1,391 @@
+#include "des.h"
+
+/*
+ * Compact engine: the same cipher as des.c but working on 64 bit words
+ * instead of binchars, with all tables packed so that the whole working set
+ * stays within a few KB of L1. Bit numbering follows the reference tables,
+ * i.e. bit 1 is the most significant bit of the block.
+ */
+
+//============================== PACKED TABLES ================================
+
+static const uint8_t IP_PACKED[64] =
+{
+  58,    50,   42,    34,    26,   18,    10,    2,
+  60,    52,   44,    36,    28,   20,    12,    4,
+  62,    54,   46,    38,    30,   22,    14,    6,
+  64,    56,   48,    40,    32,   24,    16,    8,
+  57,    49,   41,    33,    25,   17,     9,    1,
+  59,    51,   43,    35,    27,   19,    11,    3,
+  61,    53,   45,    37,    29,   21,    13,    5,
+  63,    55,   47,    39,    31,   23,    15,    7
+};
+
+static const uint8_t IP_REVERSED_PACKED[64] =
+{
+   40,   8,   48,  16,  56,  24,  64,  32,
+   39,   7,   47,  15,  55,  23,  63,  31,
+   38,   6,   46,  14,  54,  22,  62,  30,
+   37,   5,   45,  13,  53,  21,  61,  29,
+   36,   4,   44,  12,  52,  20,  60,  28,
+   35,   3,   43,  11,  51,  19,  59,  27,
+   34,   2,   42,  10,  50,  18,  58,  26,
+   33,   1,   41,   9,  49,  17,  57,  25
+};
+
+static const uint8_t P_PACKED[32] =
+{
+   16,   7,  20,  21,
+   29,  12,  28,  17,
+    1,  15,  23,  26,
+    5,  18,  31,  10,
+    2,   8,  24,  14,
+   32,  27,   3,   9,
+   19,  13,  30,   6,
+   22,  11,   4,  25
+};
+
+/*
+ * SP tables: S[i] combined with the P permutation (2 KB in total).
+ * They are indexed directly by the 6 bit chunk of the XORed data, the
+ * row/column split is already folded into the layout.
+ */
+static const uint32_t SP[8][64] =
+{
+  {
+    0x00808200, 0x00000000, 0x00008000, 0x00808202, 0x00808002, 0x00008202,
+    0x00000002, 0x00008000, 0x00000200, 0x00808200, 0x00808202, 0x00000200,
+    0x00800202, 0x00808002, 0x00800000, 0x00000002, 0x00000202, 0x00800200,
+    0x00800200, 0x00008200, 0x00008200, 0x00808000, 0x00808000, 0x00800202,
+    0x00008002, 0x00800002, 0x00800002, 0x00008002, 0x00000000, 0x00000202,
+    0x00008202, 0x00800000, 0x00008000, 0x00808202, 0x00000002, 0x00808000,
+    0x00808200, 0x00800000, 0x00800000, 0x00000200, 0x00808002, 0x00008000,
+    0x00008200, 0x00800002, 0x00000200, 0x00000002, 0x00800202, 0x00008202,
+    0x00808202, 0x00008002, 0x00808000, 0x00800202, 0x00800002, 0x00000202,
+    0x00008202, 0x00808200, 0x00000202, 0x00800200, 0x00800200, 0x00000000,
+    0x00008002, 0x00008200, 0x00000000, 0x00808002
+  },
+  {
+    0x40084010, 0x40004000, 0x00004000, 0x00084010, 0x00080000, 0x00000010,
+    0x40080010, 0x40004010, 0x40000010, 0x40084010, 0x40084000, 0x40000000,
+    0x40004000, 0x00080000, 0x00000010, 0x40080010, 0x00084000, 0x00080010,
+    0x40004010, 0x00000000, 0x40000000, 0x00004000, 0x00084010, 0x40080000,
+    0x00080010, 0x40000010, 0x00000000, 0x00084000, 0x00004010, 0x40084000,
+    0x40080000, 0x00004010, 0x00000000, 0x00084010, 0x40080010, 0x00080000,
+    0x40004010, 0x40080000, 0x40084000, 0x00004000, 0x40080000, 0x40004000,
+    0x00000010, 0x40084010, 0x00084010, 0x00000010, 0x00004000, 0x40000000,
+    0x00004010, 0x40084000, 0x00080000, 0x40000010, 0x00080010, 0x40004010,
+    0x40000010, 0x00080010, 0x00084000, 0x00000000, 0x40004000, 0x00004010,
+    0x40000000, 0x40080010, 0x40084010, 0x00084000
+  },
+  {
+    0x00000104, 0x04010100, 0x00000000, 0x04010004, 0x04000100, 0x00000000,
+    0x00010104, 0x04000100, 0x00010004, 0x04000004, 0x04000004, 0x00010000,
+    0x04010104, 0x00010004, 0x04010000, 0x00000104, 0x04000000, 0x00000004,
+    0x04010100, 0x00000100, 0x00010100, 0x04010000, 0x04010004, 0x00010104,
+    0x04000104, 0x00010100, 0x00010000, 0x04000104, 0x00000004, 0x04010104,
+    0x00000100, 0x04000000, 0x04010100, 0x04000000, 0x00010004, 0x00000104,
+    0x00010000, 0x04010100, 0x04000100, 0x00000000, 0x00000100, 0x00010004,
+    0x04010104, 0x04000100, 0x04000004, 0x00000100, 0x00000000, 0x04010004,
+    0x04000104, 0x00010000, 0x04000000, 0x04010104, 0x00000004, 0x00010104,
+    0x00010100, 0x04000004, 0x04010000, 0x04000104, 0x00000104, 0x04010000,
+    0x00010104, 0x00000004, 0x04010004, 0x00010100
+  },
+  {
+    0x80401000, 0x80001040, 0x80001040, 0x00000040, 0x00401040, 0x80400040,
+    0x80400000, 0x80001000, 0x00000000, 0x00401000, 0x00401000, 0x80401040,
+    0x80000040, 0x00000000, 0x00400040, 0x80400000, 0x80000000, 0x00001000,
+    0x00400000, 0x80401000, 0x00000040, 0x00400000, 0x80001000, 0x00001040,
+    0x80400040, 0x80000000, 0x00001040, 0x00400040, 0x00001000, 0x00401040,
+    0x80401040, 0x80000040, 0x00400040, 0x80400000, 0x00401000, 0x80401040,
+    0x80000040, 0x00000000, 0x00000000, 0x00401000, 0x00001040, 0x00400040,
+    0x80400040, 0x80000000, 0x80401000, 0x80001040, 0x80001040, 0x00000040,
+    0x80401040, 0x80000040, 0x80000000, 0x00001000, 0x80400000, 0x80001000,
+    0x00401040, 0x80400040, 0x80001000, 0x00001040, 0x00400000, 0x80401000,
+    0x00000040, 0x00400000, 0x00001000, 0x00401040
+  },
+  {
+    0x00000080, 0x01040080, 0x01040000, 0x21000080, 0x00040000, 0x00000080,
+    0x20000000, 0x01040000, 0x20040080, 0x00040000, 0x01000080, 0x20040080,
+    0x21000080, 0x21040000, 0x00040080, 0x20000000, 0x01000000, 0x20040000,
+    0x20040000, 0x00000000, 0x20000080, 0x21040080, 0x21040080, 0x01000080,
+    0x21040000, 0x20000080, 0x00000000, 0x21000000, 0x01040080, 0x01000000,
+    0x21000000, 0x00040080, 0x00040000, 0x21000080, 0x00000080, 0x01000000,
+    0x20000000, 0x01040000, 0x21000080, 0x20040080, 0x01000080, 0x20000000,
+    0x21040000, 0x01040080, 0x20040080, 0x00000080, 0x01000000, 0x21040000,
+    0x21040080, 0x00040080, 0x21000000, 0x21040080, 0x01040000, 0x00000000,
+    0x20040000, 0x21000000, 0x00040080, 0x01000080, 0x20000080, 0x00040000,
+    0x00000000, 0x20040000, 0x01040080, 0x20000080
+  },
+  {
+    0x10000008, 0x10200000, 0x00002000, 0x10202008, 0x10200000, 0x00000008,
+    0x10202008, 0x00200000, 0x10002000, 0x00202008, 0x00200000, 0x10000008,
+    0x00200008, 0x10002000, 0x10000000, 0x00002008, 0x00000000, 0x00200008,
+    0x10002008, 0x00002000, 0x00202000, 0x10002008, 0x00000008, 0x10200008,
+    0x10200008, 0x00000000, 0x00202008, 0x10202000, 0x00002008, 0x00202000,
+    0x10202000, 0x10000000, 0x10002000, 0x00000008, 0x10200008, 0x00202000,
+    0x10202008, 0x00200000, 0x00002008, 0x10000008, 0x00200000, 0x10002000,
+    0x10000000, 0x00002008, 0x10000008, 0x10202008, 0x00202000, 0x10200000,
+    0x00202008, 0x10202000, 0x00000000, 0x10200008, 0x00000008, 0x00002000,
+    0x10200000, 0x00202008, 0x00002000, 0x00200008, 0x10002008, 0x00000000,
+    0x10202000, 0x10000000, 0x00200008, 0x10002008
+  },
+  {
+    0x00100000, 0x02100001, 0x02000401, 0x00000000, 0x00000400, 0x02000401,
+    0x00100401, 0x02100400, 0x02100401, 0x00100000, 0x00000000, 0x02000001,
+    0x00000001, 0x02000000, 0x02100001, 0x00000401, 0x02000400, 0x00100401,
+    0x00100001, 0x02000400, 0x02000001, 0x02100000, 0x02100400, 0x00100001,
+    0x02100000, 0x00000400, 0x00000401, 0x02100401, 0x00100400, 0x00000001,
+    0x02000000, 0x00100400, 0x02000000, 0x00100400, 0x00100000, 0x02000401,
+    0x02000401, 0x02100001, 0x02100001, 0x00000001, 0x00100001, 0x02000000,
+    0x02000400, 0x00100000, 0x02100400, 0x00000401, 0x00100401, 0x02100400,
+    0x00000401, 0x02000001, 0x02100401, 0x02100000, 0x00100400, 0x00000000,
+    0x00000001, 0x02100401, 0x00000000, 0x00100401, 0x02100000, 0x00000400,
+    0x02000001, 0x02000400, 0x00000400, 0x00100001
+  },
+  {
+    0x08000820, 0x00000800, 0x00020000, 0x08020820, 0x08000000, 0x08000820,
+    0x00000020, 0x08000000, 0x00020020, 0x08020000, 0x08020820, 0x00020800,
+    0x08020800, 0x00020820, 0x00000800, 0x00000020, 0x08020000, 0x08000020,
+    0x08000800, 0x00000820, 0x00020800, 0x00020020, 0x08020020, 0x08020800,
+    0x00000820, 0x00000000, 0x00000000, 0x08020020, 0x08000020, 0x08000800,
+    0x00020820, 0x00020000, 0x00020820, 0x00020000, 0x08020800, 0x00000800,
+    0x00000020, 0x08020020, 0x00000800, 0x00020820, 0x08000800, 0x00000020,
+    0x08000020, 0x08020000, 0x08020020, 0x08000000, 0x00020000, 0x08000820,
+    0x00000000, 0x08020820, 0x00020020, 0x08000020, 0x08020000, 0x08000800,
+    0x08000820, 0x00000000, 0x08020820, 0x00020800, 0x00020800, 0x00000820,
+    0x00000820, 0x00020020, 0x08000000, 0x08020800
+  }
+};
+
+/*
+ * S tables packed into nibbles, one 64 bit word per row (256 bytes in total).
+ * Column c of a row lives in bits 4c..4c+3. Used by the constant-time path,
+ * which reads every row of a box on every lookup.
+ */
+static const uint64_t S_PACKED[8][4] =
+{
+  { 0x7095c6a38bf21d4eULL, 0x8359bc6a1d2e47f0ULL, 0x05a379cfb26d8e14ULL, 0xd60ae3b5719428cfULL },
+  { 0xa50cd27943b6e81fULL, 0x5b96a10ce82f74d3ULL, 0xf2396c851d4ab7e0ULL, 0x9e50c76b24f31a8dULL },
+  { 0x824b7cd15f36e90aULL, 0x1fbce582a643907dULL, 0x7ea5c21b03f8946dULL, 0xc25b3ef478960da1ULL },
+  { 0xf4cb5821a9603ed7ULL, 0x9ea1c27430f65b8dULL, 0x4825e31fd7bc096aULL, 0xe27cb5498d1a60f3ULL },
+  { 0x9e0df3586ba714c2ULL, 0x6893af051d74c2beULL, 0xe0365c9f87dab124ULL, 0x354a90f6d2e17c8bULL },
+  { 0xb57e43d08629fa1cULL, 0x83b0ed1659c724faULL, 0x6bd1a4073c825fe9ULL, 0xd80671ebaf59c234ULL },
+  { 0x16a579c3d80fe2b4ULL, 0x68f2c53ea1947b0dULL, 0x295086fae73cdb41ULL, 0xc32ef0597a418db6ULL },
+  { 0x7c05e39a1bf6482dULL, 0x29e0b65c473a8df1ULL, 0x853fda602ec914b7ULL, 0xb65309cfd8a47e12ULL }
+};
+
+// ------------------------------ HELPERS -------------------------------------
+
+/*
+ * Moves bit table[i] of the in_bits wide input to bit i+1 of the
+ * out_bits wide output.
+ */
+static uint64_t permute(uint64_t in, int in_bits, const uint8_t *table, int out_bits)
+{
+  uint64_t out = 0;
+  int i;
+  for(i=0;i<out_bits;i++)
+  {
+    out = (out << 1) | ((in >> (in_bits - table[i])) & 1);
+  }
+  return out;
+}
+
+static uint32_t rotl28(uint32_t half, int shift)
+{
+  return ((half << shift) | (half >> (28 - shift))) & 0x0FFFFFFF;
+}
+
+static uint32_t rotl32(uint32_t word, int shift)
+{
+  return (word << shift) | (word >> ((32 - shift) & 31));
+}
+
+/*
+ * Returns the 6 bit chunk i of E(right), the rotation replaces the E table.
+ */
+static uint32_t expanded_chunk(uint32_t right, int i)
+{
+  return rotl32(right,(4*i + 31) & 31) >> 26;
+}
+
+/*
+ * Looks up S[box] without a data dependent memory access: all four rows are
+ * read and the wanted one is selected with a mask.
+ */
+static uint32_t sbox_ct(int box, uint32_t chunk)
+{
+  uint32_t row = ((chunk >> 4) & 2) | (chunk & 1);
+  uint32_t col = (chunk >> 1) & 15;
+  uint64_t selected = 0;
+  uint32_t r;
+  for(r=0;r<4;r++)
+  {
+    uint64_t mask = (uint64_t)0 - (uint64_t)(((row ^ r) - 1) >> 31);
+    selected |= S_PACKED[box][r] & mask;
+  }
+  return (uint32_t)(selected >> (col * 4)) & 15;
+}
+
+static uint32_t f_compact(uint32_t right, uint64_t subkey)
+{
+  uint32_t out = 0;
+  int i;
+  for(i=0;i<8;i++)
+  {
+    uint32_t chunk = expanded_chunk(right,i) ^ (uint32_t)((subkey >> (42 - 6*i)) & 63);
+    out |= SP[i][chunk];
+  }
+  return out;
+}
+
+static uint32_t f_compact_ct(uint32_t right, uint64_t subkey)
+{
+  uint32_t sboxed = 0;
+  int i;
+  for(i=0;i<8;i++)
+  {
+    uint32_t chunk = expanded_chunk(right,i) ^ (uint32_t)((subkey >> (42 - 6*i)) & 63);
+    sboxed = (sboxed << 4) | sbox_ct(i,chunk);
+  }
+  return (uint32_t)permute(sboxed,32,P_PACKED,32);
+}
+
+static uint64_t crypt_block_with(uint64_t block, const uint64_t subkeys[16], char enorde,
+  uint32_t (*round_function)(uint32_t, uint64_t))
+{
+  uint64_t ip = permute(block,64,IP_PACKED,64);
+  uint32_t left = (uint32_t)(ip >> 32);
+  uint32_t right = (uint32_t)ip;
+  int i;
+  for(i=0;i<16;i++)
+  {
+    uint64_t subkey = subkeys[enorde == 'd' ? 15 - i : i];
+    uint32_t next = left ^ round_function(right,subkey);
+    left = right;
+    right = next;
+  }
+  // R16L16 goes through IP-1
+  return permute(((uint64_t)right << 32) | left,64,IP_REVERSED_PACKED,64);
+}
+
+// ------------------------------ PUBLIC API ----------------------------------
+
+uint64_t chars8_to_block(const char *chars8)
+{
+  uint64_t block = 0;
+  int i;
+  for(i=0;i<8;i++)
+  {
+    block = (block << 8) | (unsigned char)chars8[i];
+  }
+  return block;
+}
+
+void block_to_chars8(uint64_t block, char *chars8)
+{
+  int i;
+  for(i=7;i>=0;i--)
+  {
+    chars8[i] = (char)(block & 0xFF);
+    block >>= 8;
+  }
+}
+
+/*
+ * Derives the 16 round keys, each right aligned in its 64 bit word.
+ */
+void compact_generate_keys(const char *des_key, uint64_t subkeys[16])
+{
+  uint64_t permuted = permute(chars8_to_block(des_key),64,PC_1_PACKED,56);
+  uint32_t c = (uint32_t)(permuted >> 28);
+  uint32_t d = (uint32_t)(permuted & 0x0FFFFFFF);
+  int i;
+  for(i=0;i<16;i++)
+  {
+    int shift = ((DOUBLE_SHIFTS >> i) & 1) + 1;
+    c = rotl28(c,shift);
+    d = rotl28(d,shift);
+    subkeys[i] = permute(((uint64_t)c << 28) | d,56,PC_2_PACKED,48);
+  }
+}
+
+uint64_t compact_crypt_block(uint64_t block, const uint64_t subkeys[16], char enorde)
+{
+  return crypt_block_with(block,subkeys,enorde,f_compact);
+}
+
+/*
+ * Encrypts a block and records LnRn after every round n into rounds[n-1],
+ * for the statistics in des_stats.c. Returns the ciphertext.
+ */
+uint64_t compact_crypt_rounds(uint64_t block, const uint64_t subkeys[16], uint64_t rounds[16])
+{
+  uint64_t ip = permute(block,64,IP_PACKED,64);
+  uint32_t left = (uint32_t)(ip >> 32);
+  uint32_t right = (uint32_t)ip;
+  int i;
+  for(i=0;i<16;i++)
+  {
+    uint32_t next = left ^ f_compact(right,subkeys[i]);
+    left = right;
+    right = next;
+    rounds[i] = ((uint64_t)left << 32) | right;
+  }
+  return permute(((uint64_t)right << 32) | left,64,IP_REVERSED_PACKED,64);
+}
+
+/*
+ * Returns S[box] for a raw 6 bit chunk (row from the outer bits, column from
+ * the inner four).
+ */
+uint32_t compact_sbox_lookup(int box, uint32_t chunk)
+{
+  return sbox_ct(box,chunk & 63);
+}
+
+/*
+ * Same as compact_crypt_block() but with no key or data dependent table
+ * indexing, for callers that care about cache timing more than throughput.
+ */
+uint64_t compact_crypt_block_ct(uint64_t block, const uint64_t subkeys[16], char enorde)
+{
+  return crypt_block_with(block,subkeys,enorde,f_compact_ct);
+}
+
+/*
+ * Drop-in replacements for crypt_chunk() which leave PERMUTED_KEYS alone.
+ */
+void compact_crypt_chunk(char *text_8chars, char *key_8chars, char enorde, char *result)
+{
+  uint64_t subkeys[16];
+  compact_generate_keys(key_8chars,subkeys);
+  block_to_chars8(compact_crypt_block(chars8_to_block(text_8chars),subkeys,enorde),result);
+}
+
+void compact_crypt_chunk_ct(char *text_8chars, char *key_8chars, char enorde, char *result)
+{
+  uint64_t subkeys[16];
+  compact_generate_keys(key_8chars,subkeys);
+  block_to_chars8(compact_crypt_block_ct(chars8_to_block(text_8chars),subkeys,enorde),result);
+}
+
+/*
+ * ECB over every whole block of the buffer. A trailing partial block is left
+ * untouched in out; the number of bytes processed is returned.
+ */
+size_t compact_crypt_buffer(const char *in, char *out, size_t length,
+  const uint64_t subkeys[16], char enorde, short constant_time)
+{
+  size_t blocks = length / 8;
+  size_t n;
+  for(n=0;n<blocks;n++)
+  {
+    uint64_t block = chars8_to_block(in + n*8);
+    block = constant_time ? compact_crypt_block_ct(block,subkeys,enorde)
+                          : compact_crypt_block(block,subkeys,enorde);
+    block_to_chars8(block,out + n*8);
+  }
+  return blocks * 8;
+}
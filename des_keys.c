@@ -0,0 +1,102 @@
+#include "des.h"
+
+/*
+ * Batch key schedule, bitsliced. Each chunk of 64 keys is transposed into 64
+ * bit planes, plane b holding bit b+1 of every key, so PC-1, the rotations
+ * and PC-2 are just renames of planes. The only memory touched besides the
+ * keys and the schedules is two 512 byte plane arrays on the stack, and no
+ * address or branch depends on key bits, so the whole path runs in constant
+ * time. The round keys it writes are identical to compact_generate_keys().
+ */
+
+#define BATCH_CHUNK 64
+
+/*
+ * Transposes a 64x64 bit matrix in place, row k being a[k] with column 0 in
+ * the most significant bit. Six passes of masked swaps between row pairs.
+ */
+static void transpose64(uint64_t a[64])
+{
+  int j, k;
+  uint64_t m = 0x00000000FFFFFFFFULL;
+  for(j=32;j!=0;j>>=1,m^=(m<<j))
+  {
+    for(k=0;k<64;k=((k|j)+1)&~j)
+    {
+      uint64_t t = (a[k] ^ (a[k|j] >> j)) & m;
+      a[k] ^= t;
+      a[k|j] ^= t << j;
+    }
+  }
+}
+
+/*
+ * Index into the PC-1 planes of bit cd (0..55) of CnDn once both halves
+ * have been rotated left by shift places.
+ */
+static int rotated_plane(int cd, int shift)
+{
+  int half = cd < 28 ? 0 : 28;
+  return half + (cd - half + shift) % 28;
+}
+
+/*
+ * Derives the schedules of count keys stored back to back in keys (8 chars
+ * each). The output is structure of arrays: round key r of key k is written
+ * to schedules[r*count + k], so schedules must hold 16*count words.
+ */
+void compact_generate_keys_batch(const char *keys, size_t count, uint64_t *schedules)
+{
+  uint64_t planes[64];
+  uint64_t cd[56];
+  size_t base;
+  for(base=0;base<count;base+=BATCH_CHUNK)
+  {
+    size_t chunk = count - base < BATCH_CHUNK ? count - base : BATCH_CHUNK;
+    size_t k;
+    int i;
+    for(k=0;k<BATCH_CHUNK;k++)
+    {
+      planes[k] = k < chunk ? chars8_to_block(keys + (base + k) * 8) : 0;
+    }
+    transpose64(planes);
+    for(i=0;i<56;i++)
+    {
+      cd[i] = planes[PC_1_PACKED[i] - 1];
+    }
+
+    // subkey bit 1 lands in column 16 so every key comes back right aligned
+    int r, shift = 0;
+    for(r=0;r<16;r++)
+    {
+      shift += ((DOUBLE_SHIFTS >> r) & 1) + 1;
+      for(i=0;i<16;i++)
+      {
+        planes[i] = 0;
+      }
+      for(i=0;i<48;i++)
+      {
+        planes[16 + i] = cd[rotated_plane(PC_2_PACKED[i] - 1,shift)];
+      }
+      transpose64(planes);
+      uint64_t *out = schedules + (size_t)r * count + base;
+      for(k=0;k<chunk;k++)
+      {
+        out[k] = planes[k];
+      }
+    }
+  }
+}
+
+/*
+ * Copies the schedule of key index out of a batch, in the layout the
+ * compact_crypt_* functions take.
+ */
+void compact_schedule_gather(const uint64_t *schedules, size_t count, size_t index, uint64_t subkeys[16])
+{
+  int r;
+  for(r=0;r<16;r++)
+  {
+    subkeys[r] = schedules[(size_t)r * count + index];
+  }
+}
@@ -0,0 +1,60 @@
+#include "des.h"
+#include <unistd.h>
+
+/*
+ * Demo executable, kept out of des.c so that the library has no main().
+ */
+
+/*
+ * Entry point for "des.bin stats [samples] [threads] [seed]".
+ */
+static int stats_main(int argc, char **argv)
+{
+  uint64_t samples = argc > 2 ? strtoull(argv[2],NULL,10) : 1000000;
+  long threads = argc > 3 ? strtol(argv[3],NULL,10) : sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t seed = argc > 4 ? strtoull(argv[4],NULL,0) : 0x0123456789ABCDEFULL;
+
+  struct des_stats *stats = malloc(sizeof(struct des_stats));
+  if(!stats)
+  {
+    perror("Allocating stats failed");
+    return 1;
+  }
+  des_stats_collect(stats,samples,(int)threads,seed);
+  des_stats_print(stats);
+  free(stats);
+  return 0;
+}
+
+int main(int argc, char **argv) 
+{
+  if (argc > 1 && strcmp(argv[1],"stats") == 0)
+  {
+    return stats_main(argc,argv);
+  }
+  /*
+   * DES operates on the 64-bit blocks using key sizes of 56- bits. 
+   * The keys are actually stored as being 64 bits long, but every 8th bit in the key is not used 
+   * (i.e. bits numbered 8, 16, 24, 32, 40, 48, 56, and 64). 
+   */
+
+  char key[8] = "S0mEKee!";
+  printf("64(56) bit key: %.*s\n",8,key);
+
+  char msg[8] = "8byteMSG";
+  printf("Plain msg:      %.*s\n",8,msg);
+  
+  char result[8];
+  crypt_chunk(msg,key,'e',result);
+
+  printf("Ciphered msg:   %.*s\n",8,result); 
+
+  char decrypted[8];
+  crypt_chunk(result,key,'d',decrypted);
+
+  printf("Decrypted msg:  %.*s\n",8,decrypted);
+ 
+  //file_cipher();
+  return 0;
+};
+
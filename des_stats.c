@@ -0,0 +1,226 @@
+#include "des.h"
+#include <pthread.h>
+
+/*
+ * Avalanche and S box difference statistics. Samples are spread over worker
+ * threads, each running the compact engine on its own random plaintext/key
+ * pairs and keeping private counters that are summed at the end.
+ */
+
+/*
+ * Per thread counters, the DDT is computed once by the caller.
+ */
+struct stats_counters
+{
+  uint64_t samples;
+  uint64_t plain_flips[16][64];
+  uint64_t key_flips[16][64];
+};
+
+struct stats_worker
+{
+  pthread_t thread;
+  uint64_t samples;
+  uint64_t rng_state;
+  struct stats_counters counters;
+};
+
+// ------------------------------ SAMPLING ------------------------------------
+
+/*
+ * splitmix64, good enough for sampling and cheap to seed per thread.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static void count_flips(uint64_t flips[16][64], const uint64_t rounds[16], const uint64_t flipped[16])
+{
+  int n;
+  for(n=0;n<16;n++)
+  {
+    uint64_t diff = rounds[n] ^ flipped[n];
+    while(diff)
+    {
+      int bit = 63 - __builtin_ctzll(diff);
+      flips[n][bit]++;
+      diff &= diff - 1;
+    }
+  }
+}
+
+static void *stats_worker_run(void *arg)
+{
+  struct stats_worker *worker = arg;
+  struct stats_counters *counters = &worker->counters;
+  uint64_t subkeys[16];
+  uint64_t flipped_subkeys[16];
+  uint64_t rounds[16];
+  uint64_t flipped[16];
+  char key[8];
+  uint64_t s;
+  for(s=0;s<worker->samples;s++)
+  {
+    uint64_t plain = next_random(&worker->rng_state);
+    uint64_t key_block = next_random(&worker->rng_state);
+    uint64_t choice = next_random(&worker->rng_state);
+    block_to_chars8(key_block,key);
+    compact_generate_keys(key,subkeys);
+    compact_crypt_rounds(plain,subkeys,rounds);
+
+    // flip one plaintext bit
+    compact_crypt_rounds(plain ^ (1ULL << (choice & 63)),subkeys,flipped);
+    count_flips(counters->plain_flips,rounds,flipped);
+
+    // flip one of the 56 key bits that are not parity bits
+    int key_bit = (int)((choice >> 6) % 56);
+    key_bit = (key_bit / 7) * 8 + key_bit % 7;
+    block_to_chars8(key_block ^ (1ULL << (63 - key_bit)),key);
+    compact_generate_keys(key,flipped_subkeys);
+    compact_crypt_rounds(plain,flipped_subkeys,flipped);
+    count_flips(counters->key_flips,rounds,flipped);
+  }
+  counters->samples = worker->samples;
+  return NULL;
+}
+
+/*
+ * The difference distribution tables are exact: every input pair of every
+ * box is enumerated, which is only 4096 lookups per box.
+ */
+static void fill_ddt(struct des_stats *stats)
+{
+  int i;
+  uint32_t x, dx;
+  for(i=0;i<8;i++)
+  {
+    for(x=0;x<64;x++)
+    {
+      for(dx=0;dx<64;dx++)
+      {
+        uint32_t dy = compact_sbox_lookup(i,x) ^ compact_sbox_lookup(i,x ^ dx);
+        stats->ddt[i][dx][dy]++;
+      }
+    }
+  }
+}
+
+void des_stats_collect(struct des_stats *stats, uint64_t samples, int threads, uint64_t seed)
+{
+  memset(stats,0,sizeof(*stats));
+  fill_ddt(stats);
+  if (threads < 1) {threads = 1;};
+
+  struct stats_worker *workers = calloc(threads,sizeof(struct stats_worker));
+  if(!workers)
+  {
+    perror("Allocating stats workers failed");
+    return;
+  }
+  int t;
+  for(t=0;t<threads;t++)
+  {
+    workers[t].samples = samples / threads + ((uint64_t)t < samples % threads ? 1 : 0);
+    workers[t].rng_state = seed ^ (0xD1B54A32D192ED03ULL * (uint64_t)(t + 1));
+    if(pthread_create(&workers[t].thread,NULL,stats_worker_run,&workers[t]) != 0)
+    {
+      // fall back to running this share on the calling thread
+      stats_worker_run(&workers[t]);
+      workers[t].thread = pthread_self();
+    }
+  }
+  for(t=0;t<threads;t++)
+  {
+    if(!pthread_equal(workers[t].thread,pthread_self()))
+    {
+      pthread_join(workers[t].thread,NULL);
+    }
+    stats->samples += workers[t].counters.samples;
+    int n, b;
+    for(n=0;n<16;n++)
+    {
+      for(b=0;b<64;b++)
+      {
+        stats->plain_flips[n][b] += workers[t].counters.plain_flips[n][b];
+        stats->key_flips[n][b] += workers[t].counters.key_flips[n][b];
+      }
+    }
+  }
+  free(workers);
+}
+
+// ------------------------------ OUTPUT --------------------------------------
+
+/*
+ * Prints one row per round with the mean, min and max flip probability over
+ * the 64 bits of LnRn and a histogram of the per-bit probabilities in tenths,
+ * followed by the per-bit probabilities in percent.
+ */
+static void print_avalanche(const char *title, const uint64_t flips[16][64], uint64_t samples)
+{
+  int n, b;
+  printf("%s (%llu samples)\n",title,(unsigned long long)samples);
+  printf("round   mean    min    max   histogram 0.0 .. 1.0\n");
+  for(n=0;n<16;n++)
+  {
+    double sum = 0, min = 1, max = 0;
+    int histogram[10] = { 0 };
+    for(b=0;b<64;b++)
+    {
+      double p = (double)flips[n][b] / samples;
+      sum += p;
+      if (p < min) {min = p;};
+      if (p > max) {max = p;};
+      histogram[p >= 1 ? 9 : (int)(p * 10)]++;
+    }
+    printf("%5d  %.3f  %.3f  %.3f  |",n+1,sum / 64,min,max);
+    for(b=0;b<10;b++)
+    {
+      printf(" %2d",histogram[b]);
+    }
+    printf(" |\n");
+  }
+  for(n=0;n<16;n++)
+  {
+    printf("L%dR%d flip %%:\n",n+1,n+1);
+    for(b=0;b<64;b++)
+    {
+      printf("%4.0f%s",100.0 * flips[n][b] / samples,(b % 16 == 15) ? "\n" : "");
+    }
+  }
+  printf("\n");
+}
+
+static void print_ddt(const uint32_t ddt[64][16], int box)
+{
+  uint32_t dx, dy;
+  printf("DDT S%d (rows: input difference, columns: output difference)\n",box+1);
+  for(dx=0;dx<64;dx++)
+  {
+    printf("%02x:",dx);
+    for(dy=0;dy<16;dy++)
+    {
+      printf(" %2u",ddt[dx][dy]);
+    }
+    printf("\n");
+  }
+  printf("\n");
+}
+
+void des_stats_print(const struct des_stats *stats)
+{
+  if(stats->samples > 0)
+  {
+    print_avalanche("PLAINTEXT AVALANCHE",stats->plain_flips,stats->samples);
+    print_avalanche("KEY AVALANCHE",stats->key_flips,stats->samples);
+  }
+  int i;
+  for(i=0;i<8;i++)
+  {
+    print_ddt(stats->ddt[i],i);
+  }
+}
@@ -0,0 +1,339 @@
+#include "des.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * Verification harness, run by "make check".
+ * Usage: des_verify [groups] [seed]
+ *
+ * 1) Known answer vectors through every engine.
+ * 2) Random keys and blocks through the reference crypt_chunk(), which is
+ *    single threaded because of PERMUTED_KEYS. Blocks come in groups that
+ *    share a key so that the buffer and job paths can be checked too.
+ * 3) One batch key schedule over every group's key. The default 200 keys
+ *    cross several of its 64 key chunks and end on a partial one.
+ * 4) Every engine and mode checked against those reference results from
+ *    1, 2, 4 and all online CPUs' worth of threads at once, including
+ *    every buffer length up to a group, misalignment and in place call on
+ *    every BUFFER_GROUP_STRIDE'th group.
+ */
+
+#define GROUP_BLOCKS 8
+#define BUFFER_GROUP_STRIDE 8
+
+struct known_answer
+{
+  uint64_t key;
+  uint64_t plain;
+  uint64_t cipher;
+};
+
+static const struct known_answer KNOWN_ANSWERS[] =
+{
+  { 0x133457799BBCDFF1ULL, 0x0123456789ABCDEFULL, 0x85E813540F0AB405ULL },
+  { 0x0E329232EA6D0D73ULL, 0x8787878787878787ULL, 0x0000000000000000ULL },
+  { 0x0123456789ABCDEFULL, 0x4E6F772069732074ULL, 0x3FA40E8A984D4815ULL },
+  { 0x0000000000000000ULL, 0x0000000000000000ULL, 0x8CA64DE9C1B123A7ULL },
+  { 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x7359B2163E4EDC58ULL },
+  { 0x0101010101010101ULL, 0x8000000000000000ULL, 0x95F8A5E5DD31D900ULL },
+  { 0x3000000000000000ULL, 0x1000000000000001ULL, 0x958E6E627A05557BULL }
+};
+
+struct reference_group
+{
+  char key[8];
+  char plain[GROUP_BLOCKS * 8];
+  char cipher[GROUP_BLOCKS * 8];
+};
+
+struct verify_worker
+{
+  pthread_t thread;
+  const struct reference_group *groups;
+  const uint64_t *schedules;
+  size_t group_count;
+  int index;
+  int threads;
+  long checks;
+  long failures;
+};
+
+static uint64_t next_random(uint64_t *state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static void check(struct verify_worker *worker, int ok, const char *what, size_t group)
+{
+  worker->checks++;
+  if(!ok)
+  {
+    worker->failures++;
+    // only the first few, a broken engine fails everywhere
+    if (worker->failures <= 5) {fprintf(stderr,"FAIL %s (group %zu, %d threads)\n",what,group,worker->threads);};
+  }
+}
+
+// ------------------------------ KNOWN ANSWERS -------------------------------
+
+static long check_known_answers(void)
+{
+  long failures = 0;
+  size_t i;
+  for(i=0;i<sizeof(KNOWN_ANSWERS)/sizeof(KNOWN_ANSWERS[0]);i++)
+  {
+    const struct known_answer *kat = &KNOWN_ANSWERS[i];
+    char key[8], plain[8], cipher[8], result[8];
+    block_to_chars8(kat->key,key);
+    block_to_chars8(kat->plain,plain);
+    block_to_chars8(kat->cipher,cipher);
+
+    uint64_t subkeys[16];
+    uint64_t batch[16];
+    compact_generate_keys(key,subkeys);
+    compact_generate_keys_batch(key,1,batch);
+
+    crypt_chunk(plain,key,'e',result);
+    int ok = memcmp(result,cipher,8) == 0;
+    crypt_chunk(cipher,key,'d',result);
+    ok = ok && memcmp(result,plain,8) == 0;
+    ok = ok && compact_crypt_block(kat->plain,subkeys,'e') == kat->cipher;
+    ok = ok && compact_crypt_block(kat->cipher,subkeys,'d') == kat->plain;
+    ok = ok && compact_crypt_block_ct(kat->plain,subkeys,'e') == kat->cipher;
+    ok = ok && compact_crypt_block_ct(kat->cipher,subkeys,'d') == kat->plain;
+    ok = ok && compact_crypt_block(kat->plain,batch,'e') == kat->cipher;
+    if(!ok)
+    {
+      fprintf(stderr,"FAIL known answer %zu: key %016llx plain %016llx\n",i,
+        (unsigned long long)kat->key,(unsigned long long)kat->plain);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+// ------------------------------ REFERENCE -----------------------------------
+
+static long build_reference(struct reference_group *groups, size_t group_count, uint64_t seed)
+{
+  long failures = 0;
+  size_t g;
+  int b;
+  for(g=0;g<group_count;g++)
+  {
+    block_to_chars8(next_random(&seed),groups[g].key);
+    for(b=0;b<GROUP_BLOCKS;b++)
+    {
+      char *plain = groups[g].plain + b*8;
+      char *cipher = groups[g].cipher + b*8;
+      char back[8];
+      block_to_chars8(next_random(&seed),plain);
+      crypt_chunk(plain,groups[g].key,'e',cipher);
+      crypt_chunk(cipher,groups[g].key,'d',back);
+      if(memcmp(back,plain,8) != 0)
+      {
+        fprintf(stderr,"FAIL reference round trip (group %zu block %d)\n",g,b);
+        failures++;
+      }
+    }
+  }
+  return failures;
+}
+
+// ------------------------------ DIFFERENTIAL --------------------------------
+
+/*
+ * Whole blocks of out must match expected and the tail up to length must
+ * still hold the untouched bytes from tail.
+ */
+static int output_ok(const char *out, const char *expected, const char *tail, size_t length)
+{
+  size_t whole = length - length % 8;
+  return memcmp(out,expected,whole) == 0 && memcmp(out + whole,tail + whole,length - whole) == 0;
+}
+
+/*
+ * Runs in and expected through compact_crypt_buffer() and des_job at every
+ * length, misalignment and tail, both into a separate buffer and in place,
+ * checking that bytes past the whole blocks are left alone.
+ */
+static void check_buffers(struct verify_worker *worker, size_t g, const char *key,
+  const uint64_t subkeys[16], const char *in, const char *expected, char enorde)
+{
+  char in_buf[GROUP_BLOCKS * 8 + 16];
+  char out_buf[GROUP_BLOCKS * 8 + 16];
+  char fill[GROUP_BLOCKS * 8];
+  size_t steps[] = { 1, 3, GROUP_BLOCKS };
+  size_t length, offset, s;
+  short ct, in_place;
+  memset(fill,0xA5,sizeof(fill));
+  for(length=0;length<=GROUP_BLOCKS*8;length++)
+  {
+    size_t whole = length - length % 8;
+    for(offset=0;offset<8;offset++)
+    {
+      for(in_place=0;in_place<=1;in_place++)
+      {
+        char *src = in_buf + offset;
+        // in place shares the misalignment, otherwise the two differ
+        char *dst = in_place ? src : out_buf + (7 - offset);
+        const char *tail = in_place ? in : fill;
+        for(ct=0;ct<=1;ct++)
+        {
+          memset(out_buf,0xA5,sizeof(out_buf));
+          memcpy(src,in,length);
+          size_t done = compact_crypt_buffer(src,dst,length,subkeys,enorde,ct);
+          check(worker,done == whole && output_ok(dst,expected,tail,length),
+            in_place ? "compact_crypt_buffer in place" : "compact_crypt_buffer",g);
+        }
+        for(s=0;s<sizeof(steps)/sizeof(steps[0]);s++)
+        {
+          struct des_job job;
+          memset(out_buf,0xA5,sizeof(out_buf));
+          memcpy(src,in,length);
+          des_job_init(&job,src,dst,length,key,enorde,(short)(s & 1),steps[s],NULL,NULL);
+          des_job_run(&job);
+          check(worker,job.state == DES_JOB_DONE && job.offset == whole && output_ok(dst,expected,tail,length),
+            in_place ? "des_job in place" : "des_job",g);
+        }
+      }
+    }
+  }
+}
+
+static void *verify_worker_run(void *arg)
+{
+  struct verify_worker *worker = arg;
+  size_t g;
+  for(g=worker->index;g<worker->group_count;g+=worker->threads)
+  {
+    const struct reference_group *group = &worker->groups[g];
+    char key[8];
+    memcpy(key,group->key,8);
+    uint64_t subkeys[16];
+    uint64_t batch[16];
+    compact_generate_keys(key,subkeys);
+    compact_schedule_gather(worker->schedules,worker->group_count,g,batch);
+    check(worker,memcmp(subkeys,batch,sizeof(subkeys)) == 0,"compact_generate_keys_batch",g);
+
+    int b;
+    for(b=0;b<GROUP_BLOCKS;b++)
+    {
+      uint64_t plain = chars8_to_block(group->plain + b*8);
+      uint64_t cipher = chars8_to_block(group->cipher + b*8);
+      char result[8];
+      check(worker,compact_crypt_block(plain,subkeys,'e') == cipher,"compact_crypt_block e",g);
+      check(worker,compact_crypt_block(cipher,subkeys,'d') == plain,"compact_crypt_block d",g);
+      check(worker,compact_crypt_block_ct(plain,subkeys,'e') == cipher,"compact_crypt_block_ct e",g);
+      check(worker,compact_crypt_block_ct(cipher,subkeys,'d') == plain,"compact_crypt_block_ct d",g);
+      check(worker,compact_crypt_block(plain,batch,'e') == cipher,"batch schedule e",g);
+      uint64_t rounds[16];
+      check(worker,compact_crypt_rounds(plain,subkeys,rounds) == cipher,"compact_crypt_rounds",g);
+      check(worker,compact_crypt_block(cipher,batch,'d') == plain,"batch schedule d",g);
+      compact_crypt_chunk((char *)group->plain + b*8,key,'e',result);
+      check(worker,memcmp(result,group->cipher + b*8,8) == 0,"compact_crypt_chunk",g);
+      compact_crypt_chunk_ct((char *)group->cipher + b*8,key,'d',result);
+      check(worker,memcmp(result,group->plain + b*8,8) == 0,"compact_crypt_chunk_ct",g);
+    }
+    // the length/alignment sweep is the slow part and gains little from
+    // more random keys, so it runs on every BUFFER_GROUP_STRIDE'th group
+    if(g % BUFFER_GROUP_STRIDE == 0)
+    {
+      check_buffers(worker,g,key,subkeys,group->plain,group->cipher,'e');
+      check_buffers(worker,g,key,subkeys,group->cipher,group->plain,'d');
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Checks every group with the given number of concurrent workers.
+ */
+static long run_differential(const struct reference_group *groups, const uint64_t *schedules,
+  size_t group_count, int threads, long *checks)
+{
+  struct verify_worker *workers = calloc(threads,sizeof(struct verify_worker));
+  if(!workers)
+  {
+    perror("Allocating verify workers failed");
+    return 1;
+  }
+  int t;
+  int started = 0;
+  for(t=0;t<threads;t++)
+  {
+    workers[t].groups = groups;
+    workers[t].schedules = schedules;
+    workers[t].group_count = group_count;
+    workers[t].index = t;
+    workers[t].threads = threads;
+  }
+  for(t=0;t<threads;t++)
+  {
+    if (pthread_create(&workers[t].thread,NULL,verify_worker_run,&workers[t]) != 0) {break;};
+    started++;
+  }
+  // anything that could not get a thread runs here
+  for (t=started;t<threads;t++) {verify_worker_run(&workers[t]);};
+
+  long failures = 0;
+  for(t=0;t<threads;t++)
+  {
+    if (t < started) {pthread_join(workers[t].thread,NULL);};
+    failures += workers[t].failures;
+    *checks += workers[t].checks;
+  }
+  free(workers);
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  size_t group_count = argc > 1 ? strtoul(argv[1],NULL,10) : 200;
+  uint64_t seed = argc > 2 ? strtoull(argv[2],NULL,0) : 0x5EED5EED5EED5EEDULL;
+
+  long failures = check_known_answers();
+  printf("known answers: %ld failures\n",failures);
+
+  struct reference_group *groups = calloc(group_count,sizeof(struct reference_group));
+  if(!groups)
+  {
+    perror("Allocating reference groups failed");
+    return 1;
+  }
+  long reference_failures = build_reference(groups,group_count,seed);
+  printf("reference: %zu blocks, %ld round trip failures\n",group_count * GROUP_BLOCKS,reference_failures);
+  failures += reference_failures;
+
+  char *keys = malloc(group_count * 8);
+  uint64_t *schedules = malloc(group_count * 16 * sizeof(uint64_t));
+  if(!keys || !schedules)
+  {
+    perror("Allocating batch schedules failed");
+    return 1;
+  }
+  size_t g;
+  for (g=0;g<group_count;g++) {memcpy(keys + g*8,groups[g].key,8);};
+  compact_generate_keys_batch(keys,group_count,schedules);
+  free(keys);
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int thread_counts[] = { 1, 2, 4, cpus > 4 ? (int)cpus : 0 };
+  size_t i;
+  for(i=0;i<sizeof(thread_counts)/sizeof(thread_counts[0]);i++)
+  {
+    if (thread_counts[i] == 0) {continue;};
+    long checks = 0;
+    long differential_failures = run_differential(groups,schedules,group_count,thread_counts[i],&checks);
+    printf("differential, %d threads: %ld checks, %ld failures\n",thread_counts[i],checks,differential_failures);
+    failures += differential_failures;
+  }
+  free(schedules);
+  free(groups);
+
+  printf("%s\n",failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}
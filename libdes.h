@@ -0,0 +1,103 @@
+/*
+ * Public interface of libdes. Everything declared here is exported from
+ * libdes.so and kept source compatible; the rest of des.h is internal.
+ */
+
+#ifndef LIBDES_INCLUDED
+#define LIBDES_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define DES_API __attribute__((visibility("default")))
+#else
+#define DES_API
+#endif
+
+// ================================== REFERENCE ===============================
+
+/*
+ * The binchar based reference implementation. It keeps its round keys in a
+ * global, so it is not safe to call from several threads at once.
+ */
+DES_API void crypt_chunk(char *text_8chars, char *key_8chars, char enorde, char *result);
+
+// ================================== COMPACT =================================
+
+DES_API uint64_t chars8_to_block(const char *chars8);
+DES_API void block_to_chars8(uint64_t block, char *chars8);
+DES_API void compact_generate_keys(const char *des_key, uint64_t subkeys[16]);
+DES_API uint64_t compact_crypt_block(uint64_t block, const uint64_t subkeys[16], char enorde);
+DES_API uint64_t compact_crypt_block_ct(uint64_t block, const uint64_t subkeys[16], char enorde);
+DES_API void compact_crypt_chunk(char *text_8chars, char *key_8chars, char enorde, char *result);
+DES_API void compact_crypt_chunk_ct(char *text_8chars, char *key_8chars, char enorde, char *result);
+DES_API size_t compact_crypt_buffer(const char *in, char *out, size_t length,
+  const uint64_t subkeys[16], char enorde, short constant_time);
+
+/*
+ * Batch key setup, round key r of key k lands in schedules[r*count + k].
+ * Bitsliced over 64 keys at a time, table free and constant time.
+ */
+DES_API void compact_generate_keys_batch(const char *keys, size_t count, uint64_t *schedules);
+DES_API void compact_schedule_gather(const uint64_t *schedules, size_t count, size_t index, uint64_t subkeys[16]);
+
+// ================================== STATS ===================================
+
+/*
+ * Avalanche counters: flips[n][b] is how many samples had bit b+1 of LnRn
+ * (n = 1..16) change after flipping one random plaintext or key bit.
+ * ddt[i][dx][dy] is the difference distribution table of S[i].
+ */
+struct des_stats
+{
+  uint64_t samples;
+  uint64_t plain_flips[16][64];
+  uint64_t key_flips[16][64];
+  uint32_t ddt[8][64][16];
+};
+
+DES_API void des_stats_collect(struct des_stats *stats, uint64_t samples, int threads, uint64_t seed);
+DES_API void des_stats_print(const struct des_stats *stats);
+
+// ================================== ASYNC ===================================
+
+#define DES_JOB_DONE 0
+#define DES_JOB_PENDING 1
+
+/*
+ * State of a resumable ECB job over in[0..length). Only whole blocks are
+ * processed, a trailing partial block is left untouched in out.
+ * constant_time selects the engine as in compact_crypt_buffer().
+ * on_complete may free the job, the library does not touch it afterwards.
+ */
+struct des_job
+{
+  const char *in;
+  char *out;
+  size_t length;
+  size_t offset;
+  uint64_t subkeys[16];
+  char enorde;
+  short constant_time;
+  size_t blocks_per_step;
+  void (*on_complete)(struct des_job *job, void *user_data);
+  void *user_data;
+  int state;
+};
+
+DES_API void des_job_init(struct des_job *job, const char *in, char *out, size_t length,
+  const char *key_8chars, char enorde, short constant_time, size_t blocks_per_step,
+  void (*on_complete)(struct des_job *job, void *user_data), void *user_data);
+DES_API int des_job_step(struct des_job *job);
+DES_API size_t des_job_run(struct des_job *job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif